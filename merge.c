@@ -34,11 +34,28 @@
 #include "window_merge.h"
 
 
+/**
+ * A scheduled work function to store the size of the Buddy List pane
+ *
+ * @param[in] gtkblist   Unused
+ * @param[in] key        The preference name, either PREF_HEIGHT or PREF_WIDTH
+ * @param[in] data       The size of the Buddy List pane (as a pointer)
+**/
+static void
+store_size_work(U PidginBuddyList *gtkblist, const gchar *key, gpointer data)
+{
+  purple_prefs_set_int(key, GPOINTER_TO_INT(data));
+}
+
+
 /**
  * A callback for when the position of a GtkPaned slider changes
  *
  * This function is responsible for storing the width or height of the Buddy
- * List as a preference after the user changes it by dragging the slider.
+ * List as a preference after the user changes it by dragging the slider.  The
+ * slider emits this for every step of a drag, so the write is deferred until
+ * the main loop is idle.  Sizes reported within one main loop iteration are
+ * coalesced, but a long drag will still store several intermediate sizes.
  *
  * @param[in] gobject    Pointer to the GtkPaned structure that was resized
  * @param[in] pspec      Unused
@@ -61,10 +78,9 @@ notify_position_cb(GObject *gobject, U GParamSpec *pspec, gpointer data)
   }
 
   /* Store this size as a user preference (depending on paned orientation). */
-  if ( GTK_IS_VPANED(gobject) )
-    purple_prefs_set_int(PREF_HEIGHT, size);
-  else
-    purple_prefs_set_int(PREF_WIDTH, size);
+  pwm_schedule(gtkblist, GTK_IS_VPANED(gobject) ? PREF_HEIGHT : PREF_WIDTH,
+               PWM_WORK_PERSISTENT, store_size_work,
+               GINT_TO_POINTER(size), NULL);
 }
 
 
@@ -228,6 +244,9 @@ pwm_split_conversation(PidginBuddyList *gtkblist)
   paned = pwm_fetch(gtkblist, "paned");
   title = pwm_fetch(gtkblist, "title");
 
+  /* Finish any pending work while the windows are still merged, then stop. */
+  pwm_schedule_free(gtkblist);
+
   /* Ensure the conversation window's menu items are returned. */
   pwm_set_conv_menus_visible(gtkblist, FALSE);
 
@@ -289,6 +308,9 @@ pwm_create_paned_layout(PidginBuddyList *gtkblist, const char *side)
   gtkconvwin = pwm_blist_get_convs(gtkblist);
   old_paned = pwm_fetch(gtkblist, "paned");
 
+  /* Store any pending size preferences before the new panes read them. */
+  pwm_schedule_flush(gtkblist);
+
   /* Create the requested vertical or horizontal paned layout. */
   if ( side != NULL && (*side == 't' || *side == 'b') )
     paned = gtk_vpaned_new();
@@ -55,6 +55,66 @@ pref_convs_side_cb(U const char *name, U PurplePrefType type,
 }
 
 
+/**
+ * A scheduled work function to focus a conversation's entry field
+ *
+ * This runs as layout work, so any focus events that were already queued are
+ * processed first and do not steal focus back from the entry field.
+ *
+ * @param[in] gtkblist   Unused
+ * @param[in] key        Unused
+ * @param[in] data       Pointer to the conversation's entry widget
+**/
+static void
+focus_entry_work(U PidginBuddyList *gtkblist, U const gchar *key,
+                 gpointer data)
+{
+  /* Sanity check: The conversation may have been closed in the meantime. */
+  if ( !gtk_widget_is_toplevel(gtk_widget_get_toplevel(data)) )
+    return;
+
+  gtk_widget_grab_focus(data);
+}
+
+
+/**
+ * A scheduled work function to move conversation menu items between windows
+ *
+ * @param[in] gtkblist   The Buddy List whose menu needs adjusting
+ * @param[in] key        Unused
+ * @param[in] data       Whether the menu items are being shown (as a pointer)
+**/
+static void
+conv_menus_work(PidginBuddyList *gtkblist, U const gchar *key, gpointer data)
+{
+  pwm_set_conv_menus_visible(gtkblist, GPOINTER_TO_INT(data));
+}
+
+
+/**
+ * A scheduled work function to reset the Buddy List's title and icons
+ *
+ * This is only cosmetic, so it is checked again when it finally runs.  If a
+ * conversation replaced the instructions tab in the meantime, it owns the
+ * title and icons instead.
+ *
+ * @param[in] gtkblist   The Buddy List whose title and icons are reset
+ * @param[in] key        Unused
+ * @param[in] data       Unused
+**/
+static void
+reset_title_work(PidginBuddyList *gtkblist, U const gchar *key,
+                 U gpointer data)
+{
+  if ( pidgin_conv_get_window(pwm_fetch(gtkblist, "fake_tab")) == NULL )
+    return;
+
+  gtk_window_set_icon_list(GTK_WINDOW(gtkblist->window), NULL);
+  gtk_window_set_title(GTK_WINDOW(gtkblist->window),
+                       pwm_fetch(gtkblist, "title"));
+}
+
+
 /**
  * A callback for when a conversation is opened
  *
@@ -84,12 +144,11 @@ conversation_created_cb(PurpleConversation *conv)
   /* If there is a tab in addition to the instructions tab, remove it. */
   if ( pidgin_conv_window_get_gtkconv_count(gtkconvwin) > 1 ) {
     pwm_hide_dummy_conversation(gtkblist);
-    pwm_set_conv_menus_visible(gtkblist, TRUE);
-
-    /* Process queued focus events, and focus the conversation entry field. */
-    while ( gtk_events_pending() )
-      gtk_main_iteration();
-    gtk_widget_grab_focus(gtkconv->entry);
+    pwm_schedule(gtkblist, "conv_menus", PWM_WORK_NORMAL,
+                 conv_menus_work, GINT_TO_POINTER(TRUE), NULL);
+    pwm_schedule(gtkblist, "focus", PWM_WORK_NORMAL,
+                 focus_entry_work, g_object_ref(gtkconv->entry),
+                 g_object_unref);
   }
 }
 
@@ -119,13 +178,15 @@ deleting_conversation_cb(PurpleConversation *conv)
   if ( gtkblist == NULL )
     return;
 
-  /* If the last conv is being deleted, reset help, icons, title, and menu. */
+  /* If the last conv is being deleted, reset help, icons, title, and menu.
+     The help tab and menus go now, so the window isn't closed and no menu
+     accelerator acts on the help tab, which has no conversation. */
   if ( pidgin_conv_window_get_gtkconv_count(gtkconvwin) <= 1 ) {
     pwm_show_dummy_conversation(gtkblist);
-    gtk_window_set_icon_list(GTK_WINDOW(gtkblist->window), NULL);
-    gtk_window_set_title(GTK_WINDOW(gtkblist->window),
-                         pwm_fetch(gtkblist, "title"));
-    pwm_set_conv_menus_visible(gtkblist, FALSE);
+    pwm_schedule(gtkblist, "conv_menus", PWM_WORK_URGENT,
+                 conv_menus_work, GINT_TO_POINTER(FALSE), NULL);
+    pwm_schedule(gtkblist, "title", PWM_WORK_DEFERRABLE,
+                 reset_title_work, NULL, NULL);
   }
 }
 
@@ -374,6 +435,9 @@ plugin_init(PurplePlugin *plugin)
 
   /* Set the default side of the Buddy List window to attach conversations. */
   purple_prefs_add_string(PREF_SIDE, "right");
+
+  /* Disable logging the deferred work's time slices by default. */
+  purple_prefs_add_bool(PREF_DEBUG, FALSE);
 }
 
 /**
@@ -48,6 +48,7 @@
 #define PREF_HEIGHT PREF_ROOT "/blist_height"
 #define PREF_WIDTH  PREF_ROOT "/blist_width"
 #define PREF_SIDE   PREF_ROOT "/convs_side"
+#define PREF_DEBUG  PREF_ROOT "/debug_slices"
 
 /* Tell the libpurple headers to build this correctly. */
 #define PURPLE_PLUGINS
@@ -0,0 +1,355 @@
+/**
+ * @file schedule.c
+ * Defers the plugin's non-critical UI work behind the user's input and drawing
+ *
+ * Work is queued per Buddy List under a string key, so repeated requests for
+ * the same job (e.g. storing the pane size while the slider is being dragged)
+ * are coalesced into a single run with the most recent data.  Each job is
+ * classified by how soon it is needed:
+ *
+ * - Urgent work (menu removal) runs immediately, replacing any pending copy.
+ * - Normal work (layout, focus) runs when the main loop is idle, after pending
+ *   input events but before GTK redraws the windows.
+ * - Deferrable work (cosmetics) runs at low priority, and only for a short time
+ *   slice per main loop iteration.
+ * - Persistent work (preferences) is deferrable work that still runs if the
+ *   Buddy List window is destroyed before its turn, so no change is lost.
+ *
+ * Setting the PREF_DEBUG preference logs the duration of each time slice and
+ * the number of jobs left waiting, for measuring the effect on the main loop.
+ *
+ * @section LICENSE
+ * Copyright (C) 2012 David Michael <fedora.dm0@gmail.com>
+ *
+ * This file is part of Window Merge.
+ *
+ * Window Merge is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Window Merge is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Window Merge.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "plugin.h"
+
+#include <gtkblist.h>
+
+#include <debug.h>
+#include <prefs.h>
+
+#include "window_merge.h"
+
+/* The longest time (in microseconds) deferrable work may hold the loop. */
+#define PWM_SLICE_USEC 2000
+
+
+/**
+ * A unit of queued work waiting for its turn in the main loop
+**/
+typedef struct {
+  gchar *key;                   /*< Name used to coalesce repeated requests  */
+  PwmWorkFunc func;             /*< The function performing the work         */
+  gpointer data;                /*< User data passed to func                 */
+  GDestroyNotify notify;        /*< Function to release data, or NULL        */
+  gboolean run_on_destroy;      /*< Whether to run it if the window dies     */
+} PwmWork;
+
+/**
+ * The queues of pending work belonging to a single Buddy List
+**/
+typedef struct {
+  PidginBuddyList *gtkblist;    /*< The Buddy List owning this schedule      */
+  GQueue normal;                /*< Pending layout work                      */
+  GQueue deferrable;            /*< Pending preference and cosmetic work     */
+  guint normal_id;              /*< Idle source dispatching normal work      */
+  guint deferrable_id;          /*< Idle source dispatching deferrable work  */
+} PwmSchedule;
+
+
+/**
+ * Release a unit of work and its user data without running it
+ *
+ * @param[in] work       The work structure to be freed
+**/
+static void
+work_free(PwmWork *work)
+{
+  if ( work->notify != NULL )
+    work->notify(work->data);
+  g_free(work->key);
+  g_free(work);
+}
+
+
+/**
+ * Run a unit of work for its Buddy List, then release it
+ *
+ * @param[in] sched      The schedule the work was taken from
+ * @param[in] work       The work to run (already removed from its queue)
+**/
+static void
+work_run(PwmSchedule *sched, PwmWork *work)
+{
+  work->func(sched->gtkblist, work->key, work->data);
+  work_free(work);
+}
+
+
+/**
+ * Remove the pending work with the given key from a queue
+ *
+ * @param[in] queue      The queue to search
+ * @param[in] key        The name of the work being removed
+ * @return               The removed work, or NULL if none was queued
+**/
+static PwmWork *
+queue_steal_key(GQueue *queue, const gchar *key)
+{
+  GList *link;                  /*< An element of the queue (iteration)      */
+  PwmWork *work;                /*< The work held by the current element     */
+
+  for ( link = queue->head; link != NULL; link = link->next ) {
+    work = link->data;
+    if ( g_strcmp0(work->key, key) == 0 ) {
+      g_queue_delete_link(queue, link);
+      return work;
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+ * An idle callback to run all pending layout work
+ *
+ * @param[in] data       Pointer to the schedule with pending work
+ * @return               Whether to keep this idle source
+**/
+static gboolean
+normal_idle_cb(gpointer data)
+{
+  PwmSchedule *sched;           /*< The schedule being dispatched            */
+
+  sched = data;
+
+  /* Pop each job first, in case it schedules more work while it runs. */
+  while ( !g_queue_is_empty(&sched->normal) )
+    work_run(sched, g_queue_pop_head(&sched->normal));
+
+  sched->normal_id = 0;
+  return FALSE;
+}
+
+
+/**
+ * An idle callback to run pending deferrable work within a time slice
+ *
+ * Jobs are run in the order they were requested until the slice is used up.
+ * Anything left over waits for the next time the main loop is otherwise idle,
+ * so a burst of incoming messages is never stuck behind this plugin's work.
+ *
+ * @param[in] data       Pointer to the schedule with pending work
+ * @return               Whether to keep this idle source
+**/
+static gboolean
+deferrable_idle_cb(gpointer data)
+{
+  PwmSchedule *sched;           /*< The schedule being dispatched            */
+  PwmWork *work;                /*< The unit of work being run               */
+  gint64 start;                 /*< Monotonic time when this slice began     */
+  gint64 elapsed = 0;           /*< Time spent running work in this slice    */
+  guint count = 0;              /*< Number of jobs run in this slice         */
+
+  sched = data;
+  start = g_get_monotonic_time();
+
+  /* Stop early once the slice is spent; the rest can wait for the next one. */
+  while ( elapsed < PWM_SLICE_USEC &&
+          (work = g_queue_pop_head(&sched->deferrable)) != NULL ) {
+    work_run(sched, work);
+    elapsed = g_get_monotonic_time() - start;
+    count++;
+  }
+
+  if ( purple_prefs_get_bool(PREF_DEBUG) )
+    purple_debug_misc(PLUGIN_TOKEN, "Deferred slice: %u job(s) in %"
+                      G_GINT64_FORMAT " usec, %u waiting\n", count, elapsed,
+                      g_queue_get_length(&sched->deferrable));
+
+  if ( !g_queue_is_empty(&sched->deferrable) )
+    return TRUE;
+
+  sched->deferrable_id = 0;
+  return FALSE;
+}
+
+
+/**
+ * Discard a Buddy List's schedule when its window is destroyed
+ *
+ * This is the destroy notification for the schedule's object data.  The
+ * window is going away, so pending work on its widgets is dropped.  Work that
+ * was scheduled as persistent is still run to keep the user's last change.
+ *
+ * @param[in] data       Pointer to the schedule being destroyed
+**/
+static void
+schedule_destroy(gpointer data)
+{
+  PwmSchedule *sched;           /*< The schedule being destroyed             */
+  PwmWork *work;                /*< A unit of work being discarded           */
+
+  sched = data;
+
+  if ( sched->normal_id != 0 )
+    g_source_remove(sched->normal_id);
+  if ( sched->deferrable_id != 0 )
+    g_source_remove(sched->deferrable_id);
+
+  while ( (work = g_queue_pop_head(&sched->normal)) != NULL )
+    work_free(work);
+  while ( (work = g_queue_pop_head(&sched->deferrable)) != NULL )
+    if ( work->run_on_destroy )
+      work_run(sched, work);
+    else
+      work_free(work);
+
+  g_free(sched);
+}
+
+
+/**
+ * Queue (or immediately run) a unit of work for the given Buddy List
+ *
+ * If work with the same key is already pending, it is discarded in favor of
+ * this request, so only the most recent data for each key is ever used.
+ *
+ * @param[in] gtkblist   The Buddy List the work applies to
+ * @param[in] key        A name for this work, used to coalesce requests
+ * @param[in] priority   How soon the work needs to be performed
+ * @param[in] func       The function to perform the work
+ * @param[in] data       User data to pass to func
+ * @param[in] notify     Function to release data after running, or NULL
+**/
+void
+pwm_schedule(PidginBuddyList *gtkblist, const gchar *key,
+             PwmWorkPriority priority, PwmWorkFunc func,
+             gpointer data, GDestroyNotify notify)
+{
+  PwmSchedule *sched;           /*< The Buddy List's pending work            */
+  PwmWork *work;                /*< The new (or replaced) unit of work       */
+
+  sched = pwm_fetch(gtkblist, "schedule");
+
+  /* Create the Buddy List's schedule on its first use. */
+  if ( sched == NULL ) {
+    sched = g_new0(PwmSchedule, 1);
+    sched->gtkblist = gtkblist;
+    g_queue_init(&sched->normal);
+    g_queue_init(&sched->deferrable);
+    pwm_store_full(gtkblist, "schedule", sched, schedule_destroy);
+  }
+
+  /* Drop any older request for the same work; this one supersedes it. */
+  if ( (work = queue_steal_key(&sched->normal, key)) != NULL ||
+       (work = queue_steal_key(&sched->deferrable, key)) != NULL )
+    work_free(work);
+
+  work = g_new0(PwmWork, 1);
+  work->key = g_strdup(key);
+  work->func = func;
+  work->data = data;
+  work->notify = notify;
+  work->run_on_destroy = priority == PWM_WORK_PERSISTENT;
+
+  switch ( priority ) {
+    case PWM_WORK_URGENT:
+      work_run(sched, work);
+      break;
+
+    case PWM_WORK_NORMAL:
+      g_queue_push_tail(&sched->normal, work);
+      if ( sched->normal_id == 0 )
+        sched->normal_id = g_idle_add_full(G_PRIORITY_HIGH_IDLE,
+                                           normal_idle_cb, sched, NULL);
+      break;
+
+    case PWM_WORK_DEFERRABLE:
+    case PWM_WORK_PERSISTENT:
+    default:
+      g_queue_push_tail(&sched->deferrable, work);
+      if ( sched->deferrable_id == 0 )
+        sched->deferrable_id = g_idle_add_full(G_PRIORITY_LOW,
+                                               deferrable_idle_cb, sched,
+                                               NULL);
+      break;
+  }
+}
+
+
+/**
+ * Immediately run all of a Buddy List's pending work
+ *
+ * This should be called before anything that depends on the results of queued
+ * work, such as reading back a preference that may not have been stored yet.
+ *
+ * @param[in] gtkblist   The Buddy List whose pending work should be finished
+**/
+void
+pwm_schedule_flush(PidginBuddyList *gtkblist)
+{
+  PwmSchedule *sched;           /*< The Buddy List's pending work            */
+
+  sched = pwm_fetch(gtkblist, "schedule");
+
+  /* Sanity check: If nothing was ever scheduled, there's nothing to run. */
+  if ( sched == NULL )
+    return;
+
+  /* Layout work goes first, since it is what the user would see next. */
+  while ( !g_queue_is_empty(&sched->normal) )
+    work_run(sched, g_queue_pop_head(&sched->normal));
+  while ( !g_queue_is_empty(&sched->deferrable) )
+    work_run(sched, g_queue_pop_head(&sched->deferrable));
+
+  /* Remove the idle sources now that their queues are empty. */
+  if ( sched->normal_id != 0 ) {
+    g_source_remove(sched->normal_id);
+    sched->normal_id = 0;
+  }
+  if ( sched->deferrable_id != 0 ) {
+    g_source_remove(sched->deferrable_id);
+    sched->deferrable_id = 0;
+  }
+}
+
+
+/**
+ * Run all of a Buddy List's pending work, and release its schedule
+ *
+ * This should be called while the Buddy List is still merged, so that the
+ * pending work still has the widgets it expects.  Anything scheduled later
+ * will start a new schedule.
+ *
+ * @param[in] gtkblist   The Buddy List whose schedule is no longer needed
+**/
+void
+pwm_schedule_free(PidginBuddyList *gtkblist)
+{
+  PwmSchedule *sched;           /*< The Buddy List's pending work            */
+
+  pwm_schedule_flush(gtkblist);
+  sched = pwm_clear(gtkblist, "schedule");
+
+  /* Sanity check: If nothing was ever scheduled, there's nothing to free. */
+  if ( sched != NULL )
+    schedule_destroy(sched);
+}
@@ -36,6 +36,19 @@ void pwm_show_dummy_conversation(PidginBuddyList *);
 void pwm_hide_dummy_conversation(PidginBuddyList *);
 void pwm_free_dummy_conversation(PidginBuddyList *);
 
+/* Scheduling Functions */
+typedef enum {
+  PWM_WORK_URGENT,              /*< Run immediately (menu removal)           */
+  PWM_WORK_NORMAL,              /*< Run before redrawing (layout and focus)  */
+  PWM_WORK_DEFERRABLE,          /*< Run when idle (cosmetic updates)         */
+  PWM_WORK_PERSISTENT           /*< Deferrable, but kept on destroy (prefs)  */
+} PwmWorkPriority;
+typedef void (*PwmWorkFunc)(PidginBuddyList *, const gchar *, gpointer);
+void pwm_schedule(PidginBuddyList *, const gchar *, PwmWorkPriority,
+                  PwmWorkFunc, gpointer, GDestroyNotify);
+void pwm_schedule_flush(PidginBuddyList *);
+void pwm_schedule_free(PidginBuddyList *);
+
 /* Utility Functions */
 PidginWindow *pwm_blist_get_convs(PidginBuddyList *);
 PidginBuddyList *pwm_convs_get_blist(PidginWindow *);
@@ -44,6 +57,10 @@ void pwm_widget_replace(GtkWidget *, GtkWidget *, GtkWidget *);
 #define pwm_store(pidgin_window, name, value) \
   g_object_set_data(G_OBJECT((pidgin_window)->window), "pwm_" name, value)
 
+#define pwm_store_full(pidgin_window, name, value, notify) \
+  g_object_set_data_full(G_OBJECT((pidgin_window)->window), "pwm_" name, \
+                         value, notify)
+
 #define pwm_fetch(pidgin_window, name) \
   g_object_get_data(G_OBJECT((pidgin_window)->window), "pwm_" name)
 